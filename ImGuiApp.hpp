@@ -8,6 +8,7 @@
 #include <chrono>
 #include <cstdio>
 #include <iostream>
+#include <memory>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -16,6 +17,9 @@
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_vulkan.h"
 #include "implot.h"
+
+#include "RetainedGeometryRenderer.hpp"
+
 #define GLFW_INCLUDE_VULKAN
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
@@ -233,7 +237,11 @@ static void CleanupVulkanWindow() {
   ImGui_ImplVulkanH_DestroyWindow(g_Instance, g_Device, &g_MainWindowData, g_Allocator);
 }
 
-static void FrameRender(ImGui_ImplVulkanH_Window *wd, ImDrawData *draw_data) {
+static void FrameRender(
+    ImGui_ImplVulkanH_Window *wd,
+    ImDrawData *draw_data,
+    RetainedGeometryRenderer *retained_renderer = nullptr
+) {
   VkResult result;
   VkSemaphore image_acquired_semaphore  = wd->FrameSemaphores[wd->SemaphoreIndex].ImageAcquiredSemaphore;
   VkSemaphore render_complete_semaphore = wd->FrameSemaphores[wd->SemaphoreIndex].RenderCompleteSemaphore;
@@ -275,6 +283,11 @@ static void FrameRender(ImGui_ImplVulkanH_Window *wd, ImDrawData *draw_data) {
     result = vkBeginCommandBuffer(fd->CommandBuffer, &info);
     check_vk_result(result);
   }
+
+  // Copy the changed geometry, transfers are not allowed inside a render pass
+  if (retained_renderer)
+    retained_renderer->UploadDrawData(draw_data, wd->FrameIndex, fd->CommandBuffer);
+
   {
     VkRenderPassBeginInfo info    = {};
     info.sType                    = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -288,7 +301,10 @@ static void FrameRender(ImGui_ImplVulkanH_Window *wd, ImDrawData *draw_data) {
   }
 
   // Record dear imgui primitives into command buffer
-  ImGui_ImplVulkan_RenderDrawData(draw_data, fd->CommandBuffer);
+  if (retained_renderer)
+    retained_renderer->RenderDrawData(draw_data, fd->CommandBuffer);
+  else
+    ImGui_ImplVulkan_RenderDrawData(draw_data, fd->CommandBuffer);
 
   // Submit command buffer
   vkCmdEndRenderPass(fd->CommandBuffer);
@@ -346,6 +362,10 @@ struct AppSettings {
   std::string title = "Dear ImGui GLFW+Vulkan example";
   bool showDemo     = false;
   float frameRate   = 30.0f;
+
+  // Keep the geometry of the main viewport in device memory and upload only the draw lists that changed
+  bool retainedGeometry = false;
+  bool showRenderStats  = false;
 };
 
 template <typename Derived>
@@ -359,6 +379,7 @@ class App : public Derived {
   ImVec4 clear_color           = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
   float m_frameDuration        = 33.33333f;
   double m_lastFrameTime;
+  std::unique_ptr<RetainedGeometryRenderer> m_retainedRenderer;
 
 public:
   explicit App(AppSettings appSettings = AppSettings{})
@@ -419,6 +440,9 @@ public:
       if (m_settings.showDemo)
         ImGui::ShowDemoWindow(&m_settings.showDemo);
 
+      if (m_settings.showRenderStats)
+        ShowRenderStats();
+
       // Rendering
       ImGui::Render();
       ImDrawData *main_draw_data   = ImGui::GetDrawData();
@@ -428,7 +452,7 @@ public:
       wd->ClearValue.color.float32[2] = clear_color.z * clear_color.w;
       wd->ClearValue.color.float32[3] = clear_color.w;
       if (!main_is_minimized)
-        FrameRender(wd, main_draw_data);
+        FrameRender(wd, main_draw_data, m_retainedRenderer.get());
 
       // Update and Render additional Platform Windows
       if (m_imGuiConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
@@ -443,6 +467,18 @@ public:
   }
 
 private:
+  void ShowRenderStats() {
+    ImGui::Begin("Renderer stats", &m_settings.showRenderStats);
+    if (m_retainedRenderer) {
+      const auto &stats = m_retainedRenderer->GetStats();
+      ImGui::Text("Uploaded: %d lists, %.1f KiB/frame", stats.uploadedLists, stats.uploadedBytes / 1024.0f);
+      ImGui::Text("Cached:   %d lists, %.1f KiB/frame", stats.cachedLists, stats.cachedBytes / 1024.0f);
+    } else {
+      ImGui::TextUnformatted("Retained geometry disabled, every draw list is uploaded each frame");
+    }
+    ImGui::End();
+  }
+
   void Init() {
     // Setup GLFW window
     glfwSetErrorCallback(KCE::glfw_error_callback);
@@ -522,6 +558,18 @@ private:
     init_info.CheckVkResultFn           = check_vk_result;
     ImGui_ImplVulkan_Init(&init_info, wd->RenderPass);
 
+    if (m_settings.retainedGeometry) {
+      RetainedGeometryRenderer::InitInfo retained_info = {};
+      retained_info.physicalDevice                     = g_PhysicalDevice;
+      retained_info.device                             = g_Device;
+      retained_info.renderPass                         = wd->RenderPass;
+      retained_info.subpass                            = 0;
+      retained_info.pipelineCache                      = g_PipelineCache;
+      retained_info.allocator                          = g_Allocator;
+      retained_info.checkVkResultFn                    = check_vk_result;
+      m_retainedRenderer = std::make_unique<RetainedGeometryRenderer>(retained_info);
+    }
+
     // Load Fonts
     // - If no fonts are loaded, dear imgui will use the default font. You can also load multiple fonts and use
     // ImGui::PushFont()/PopFont() to select them.
@@ -575,6 +623,7 @@ private:
     // Cleanup
     auto result = vkDeviceWaitIdle(g_Device);
     check_vk_result(result);
+    m_retainedRenderer.reset();
     ImGui_ImplVulkan_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -0,0 +1,661 @@
+#include "RetainedGeometryRenderer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+
+// See CreatePipeline(): the descriptor set layout of the backend is recreated here and must match exactly
+static_assert(
+    IMGUI_VERSION_NUM >= 18600 && IMGUI_VERSION_NUM < 19000,
+    "RetainedGeometryRenderer mirrors the descriptor set layout of imgui_impl_vulkan.cpp from Dear ImGui 1.86 to 1.89, "
+    "check ImGui_ImplVulkan_CreateDeviceObjects() and update CreatePipeline() before extending this range"
+);
+
+namespace KCE {
+
+namespace {
+
+// SPIR-V assembled from shaders/imgui.{vert,frag}.spvasm, see CMakeLists.txt
+constexpr uint32_t s_vertexShaderSpv[] =
+#include "imgui.vert.u32"
+    ;
+constexpr uint32_t s_fragmentShaderSpv[] =
+#include "imgui.frag.u32"
+    ;
+
+constexpr VkDeviceSize kInitialGeometryBufferSize = 1 << 20;
+constexpr VkDeviceSize kRegionAlignment           = 16;
+constexpr VkDeviceSize kIndexAlignment            = 4;
+
+VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+} // namespace
+
+RetainedGeometryRenderer::RetainedGeometryRenderer(const InitInfo &initInfo) : m_initInfo{initInfo} {
+  IM_ASSERT(m_initInfo.physicalDevice != VK_NULL_HANDLE);
+  IM_ASSERT(m_initInfo.device != VK_NULL_HANDLE);
+  IM_ASSERT(m_initInfo.renderPass != VK_NULL_HANDLE);
+  CreatePipeline();
+}
+
+RetainedGeometryRenderer::~RetainedGeometryRenderer() {
+  // The caller is responsible for the device being idle.
+  for (auto &pending : m_pendingBuffers)
+    DestroyBuffer(pending.buffer);
+  for (auto &frame : m_frames)
+    DestroyBuffer(frame.staging);
+  DestroyBuffer(m_geometry);
+
+  VkDevice device = m_initInfo.device;
+  vkDestroyPipeline(device, m_pipeline, m_initInfo.allocator);
+  vkDestroyPipelineLayout(device, m_pipelineLayout, m_initInfo.allocator);
+  vkDestroyDescriptorSetLayout(device, m_descriptorSetLayout, m_initInfo.allocator);
+  vkDestroySampler(device, m_sampler, m_initInfo.allocator);
+}
+
+void RetainedGeometryRenderer::UploadDrawData(
+    ImDrawData *drawData,
+    uint32_t frameIndex,
+    VkCommandBuffer commandBuffer
+) {
+  BeginFrame(frameIndex);
+  m_uploads.clear();
+
+  // Compare every draw list with the copy of its last upload to find the ones whose geometry changed
+  size_t totalBytes         = 0;
+  VkDeviceSize requiredSize = 0;
+  bool outOfSpace           = false;
+  for (int n = 0; n < drawData->CmdListsCount; n++) {
+    const ImDrawList *cmdList = drawData->CmdLists[n];
+    const size_t vertexBytes  = cmdList->VtxBuffer.Size * sizeof(ImDrawVert);
+    const size_t indexBytes   = cmdList->IdxBuffer.Size * sizeof(ImDrawIdx);
+    if (vertexBytes == 0 || indexBytes == 0)
+      continue;
+    totalBytes += vertexBytes + indexBytes;
+
+    auto [it, inserted] = m_entries.try_emplace(cmdList);
+    CacheEntry &entry   = it->second;
+    const bool cached   = !inserted && entry.vertexBytes == vertexBytes && entry.indexBytes == indexBytes &&
+                        std::memcmp(entry.shadow.data(), cmdList->VtxBuffer.Data, vertexBytes) == 0 &&
+                        std::memcmp(entry.shadow.data() + vertexBytes, cmdList->IdxBuffer.Data, indexBytes) == 0;
+    if (!cached) {
+      ReleaseRegion(entry);
+      entry.shadow.resize(vertexBytes + indexBytes);
+      std::memcpy(entry.shadow.data(), cmdList->VtxBuffer.Data, vertexBytes);
+      std::memcpy(entry.shadow.data() + vertexBytes, cmdList->IdxBuffer.Data, indexBytes);
+      entry.vertexBytes = vertexBytes;
+      entry.indexBytes  = indexBytes;
+      entry.indexOffset = AlignUp(vertexBytes, kIndexAlignment);
+      entry.region      = {0, 0};
+      const VkDeviceSize regionSize = AlignUp(entry.indexOffset + indexBytes, kRegionAlignment);
+      if (!outOfSpace && !AllocateRegion(regionSize, entry.region))
+        outOfSpace = true;
+      m_uploads.emplace_back(cmdList, &entry);
+    }
+    entry.lastUsedSerial = m_serial;
+    requiredSize += AlignUp(entry.indexOffset + indexBytes, kRegionAlignment);
+  }
+
+  // Forget the draw lists that are not rendered anymore (closed or collapsed windows)
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+    if (it->second.lastUsedSerial != m_serial) {
+      ReleaseRegion(it->second);
+      it = m_entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  // Not enough room: move to a bigger buffer and upload everything again
+  if (outOfSpace) {
+    if (!GrowGeometryBuffer(requiredSize)) {
+      DropCache();
+      return;
+    }
+    m_uploads.clear();
+    for (int n = 0; n < drawData->CmdListsCount; n++) {
+      const ImDrawList *cmdList = drawData->CmdLists[n];
+      auto it                   = m_entries.find(cmdList);
+      if (it == m_entries.end())
+        continue;
+      CacheEntry &entry = it->second;
+      const bool allocated =
+          AllocateRegion(AlignUp(entry.indexOffset + entry.indexBytes, kRegionAlignment), entry.region);
+      IM_ASSERT(allocated);
+      IM_UNUSED(allocated);
+      m_uploads.emplace_back(cmdList, &entry);
+    }
+  }
+
+  VkDeviceSize uploadSize = 0;
+  m_stats                 = {};
+  for (const auto &[cmdList, entry] : m_uploads) {
+    uploadSize += entry->region.size;
+    m_stats.uploadedBytes += entry->vertexBytes + entry->indexBytes;
+  }
+  m_stats.uploadedLists = static_cast<int>(m_uploads.size());
+  m_stats.cachedLists   = static_cast<int>(m_entries.size() - m_uploads.size());
+  m_stats.cachedBytes   = totalBytes - m_stats.uploadedBytes;
+  if (uploadSize == 0)
+    return;
+
+  // The fence of this frame has been waited on, so its staging buffer can be rewritten
+  FrameData &frame = m_frames[frameIndex];
+  if (frame.staging.size < uploadSize) {
+    const VkDeviceSize stagingSize = std::max(uploadSize, frame.staging.size * 2);
+    DestroyBuffer(frame.staging);
+    if (!CreateBuffer(
+            frame.staging,
+            stagingSize,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        )) {
+      // The changed lists cannot be uploaded, nothing is drawn from the cache this frame
+      DropCache();
+      return;
+    }
+  }
+
+  m_copies.clear();
+  auto staging               = static_cast<char *>(frame.staging.mapped);
+  VkDeviceSize stagingOffset = 0;
+  for (const auto &[cmdList, entry] : m_uploads) {
+    std::memcpy(staging + stagingOffset, cmdList->VtxBuffer.Data, entry->vertexBytes);
+    std::memcpy(staging + stagingOffset + entry->indexOffset, cmdList->IdxBuffer.Data, entry->indexBytes);
+    m_copies.push_back({stagingOffset, entry->region.offset, entry->region.size});
+    stagingOffset += entry->region.size;
+  }
+  vkCmdCopyBuffer(commandBuffer, frame.staging.handle, m_geometry.handle, (uint32_t)m_copies.size(), m_copies.data());
+
+  VkBufferMemoryBarrier barrier = {};
+  barrier.sType                 = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  barrier.srcAccessMask         = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask         = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+  barrier.srcQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+  barrier.buffer                = m_geometry.handle;
+  barrier.offset                = 0;
+  barrier.size                  = VK_WHOLE_SIZE;
+  vkCmdPipelineBarrier(
+      commandBuffer,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+      0,
+      0,
+      nullptr,
+      1,
+      &barrier,
+      0,
+      nullptr
+  );
+}
+
+void RetainedGeometryRenderer::RenderDrawData(ImDrawData *drawData, VkCommandBuffer commandBuffer) {
+  // Avoid rendering when minimized, scale coordinates for retina displays (screen coordinates != framebuffer
+  // coordinates)
+  const int fbWidth  = (int)(drawData->DisplaySize.x * drawData->FramebufferScale.x);
+  const int fbHeight = (int)(drawData->DisplaySize.y * drawData->FramebufferScale.y);
+  if (fbWidth <= 0 || fbHeight <= 0)
+    return;
+
+  SetupRenderState(drawData, commandBuffer, fbWidth, fbHeight);
+
+  // Project scissor/clipping rectangles into framebuffer space
+  const ImVec2 clipOffset = drawData->DisplayPos;
+  const ImVec2 clipScale  = drawData->FramebufferScale;
+
+  for (int n = 0; n < drawData->CmdListsCount; n++) {
+    const ImDrawList *cmdList = drawData->CmdLists[n];
+    // Lists without geometry (e.g. only user callbacks) have no cache entry, their callbacks must still run
+    auto it                 = m_entries.find(cmdList);
+    const CacheEntry *entry = it != m_entries.end() ? &it->second : nullptr;
+    if (entry)
+      BindGeometry(commandBuffer, *entry);
+
+    for (int cmd_i = 0; cmd_i < cmdList->CmdBuffer.Size; cmd_i++) {
+      const ImDrawCmd *pcmd = &cmdList->CmdBuffer[cmd_i];
+      if (pcmd->UserCallback != nullptr) {
+        if (pcmd->UserCallback == ImDrawCallback_ResetRenderState) {
+          SetupRenderState(drawData, commandBuffer, fbWidth, fbHeight);
+          if (entry)
+            BindGeometry(commandBuffer, *entry);
+        } else {
+          pcmd->UserCallback(cmdList, pcmd);
+        }
+        continue;
+      }
+      if (!entry)
+        continue;
+
+      ImVec2 clipMin((pcmd->ClipRect.x - clipOffset.x) * clipScale.x, (pcmd->ClipRect.y - clipOffset.y) * clipScale.y);
+      ImVec2 clipMax((pcmd->ClipRect.z - clipOffset.x) * clipScale.x, (pcmd->ClipRect.w - clipOffset.y) * clipScale.y);
+      // Clamp to viewport as vkCmdSetScissor() won't accept values that are off bounds
+      clipMin.x = std::max(clipMin.x, 0.0f);
+      clipMin.y = std::max(clipMin.y, 0.0f);
+      clipMax.x = std::min(clipMax.x, (float)fbWidth);
+      clipMax.y = std::min(clipMax.y, (float)fbHeight);
+      if (clipMax.x <= clipMin.x || clipMax.y <= clipMin.y)
+        continue;
+
+      VkRect2D scissor;
+      scissor.offset.x      = (int32_t)clipMin.x;
+      scissor.offset.y      = (int32_t)clipMin.y;
+      scissor.extent.width  = (uint32_t)(clipMax.x - clipMin.x);
+      scissor.extent.height = (uint32_t)(clipMax.y - clipMin.y);
+      vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+      // The Dear ImGui Vulkan backend stores a VkDescriptorSet in ImTextureID
+      auto descriptorSet = (VkDescriptorSet)pcmd->GetTexID();
+      vkCmdBindDescriptorSets(
+          commandBuffer,
+          VK_PIPELINE_BIND_POINT_GRAPHICS,
+          m_pipelineLayout,
+          0,
+          1,
+          &descriptorSet,
+          0,
+          nullptr
+      );
+      vkCmdDrawIndexed(commandBuffer, pcmd->ElemCount, 1, pcmd->IdxOffset, (int32_t)pcmd->VtxOffset, 0);
+    }
+  }
+
+  // Leave the scissor covering the whole framebuffer for whatever is recorded next
+  VkRect2D scissor = {{0, 0}, {(uint32_t)fbWidth, (uint32_t)fbHeight}};
+  vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+void RetainedGeometryRenderer::CreatePipeline() {
+  VkResult result;
+  VkDevice device = m_initInfo.device;
+
+  // Same sampler and layouts as the Dear ImGui backend: pipeline layouts must be compatible to bind its descriptor
+  // sets, and descriptor set layouts with immutable samplers are only compatible with identically created samplers.
+  // This mirrors imgui_impl_vulkan.cpp from Dear ImGui 1.86 (ImTextureID as VkDescriptorSet) to 1.89 (the docking
+  // branch this project was written against), where the layout is one COMBINED_IMAGE_SAMPLER in the fragment stage
+  // with bd->FontSampler as immutable sampler and the push constants are two vec2 in the vertex stage. Check
+  // ImGui_ImplVulkan_CreateDeviceObjects() again when updating libs/imgui, the static_assert at the top of this file
+  // stops the build outside of the checked range.
+  {
+    VkSamplerCreateInfo info = {};
+    info.sType               = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    info.magFilter           = VK_FILTER_LINEAR;
+    info.minFilter           = VK_FILTER_LINEAR;
+    info.mipmapMode          = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    info.addressModeU        = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    info.addressModeV        = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    info.addressModeW        = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    info.minLod              = -1000;
+    info.maxLod              = 1000;
+    info.maxAnisotropy       = 1.0f;
+    result                   = vkCreateSampler(device, &info, m_initInfo.allocator, &m_sampler);
+    CheckVkResult(result);
+  }
+  {
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.descriptorType               = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount              = 1;
+    binding.stageFlags                   = VK_SHADER_STAGE_FRAGMENT_BIT;
+    binding.pImmutableSamplers           = &m_sampler;
+    VkDescriptorSetLayoutCreateInfo info = {};
+    info.sType                           = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    info.bindingCount                    = 1;
+    info.pBindings                       = &binding;
+    result = vkCreateDescriptorSetLayout(device, &info, m_initInfo.allocator, &m_descriptorSetLayout);
+    CheckVkResult(result);
+  }
+  {
+    // Push constants: vec2 scale, vec2 translate
+    VkPushConstantRange pushConstants = {};
+    pushConstants.stageFlags          = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstants.offset              = 0;
+    pushConstants.size                = sizeof(float) * 4;
+    VkPipelineLayoutCreateInfo info   = {};
+    info.sType                        = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    info.setLayoutCount               = 1;
+    info.pSetLayouts                  = &m_descriptorSetLayout;
+    info.pushConstantRangeCount       = 1;
+    info.pPushConstantRanges          = &pushConstants;
+    result = vkCreatePipelineLayout(device, &info, m_initInfo.allocator, &m_pipelineLayout);
+    CheckVkResult(result);
+  }
+
+  VkShaderModule vertexModule, fragmentModule;
+  {
+    VkShaderModuleCreateInfo info = {};
+    info.sType                    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    info.codeSize                 = sizeof(s_vertexShaderSpv);
+    info.pCode                    = s_vertexShaderSpv;
+    result                        = vkCreateShaderModule(device, &info, m_initInfo.allocator, &vertexModule);
+    CheckVkResult(result);
+    info.codeSize = sizeof(s_fragmentShaderSpv);
+    info.pCode    = s_fragmentShaderSpv;
+    result        = vkCreateShaderModule(device, &info, m_initInfo.allocator, &fragmentModule);
+    CheckVkResult(result);
+  }
+
+  VkPipelineShaderStageCreateInfo stages[2] = {};
+  stages[0].sType                           = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  stages[0].stage                           = VK_SHADER_STAGE_VERTEX_BIT;
+  stages[0].module                          = vertexModule;
+  stages[0].pName                           = "main";
+  stages[1].sType                           = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  stages[1].stage                           = VK_SHADER_STAGE_FRAGMENT_BIT;
+  stages[1].module                          = fragmentModule;
+  stages[1].pName                           = "main";
+
+  VkVertexInputBindingDescription bindingDesc = {};
+  bindingDesc.stride                          = sizeof(ImDrawVert);
+  bindingDesc.inputRate                       = VK_VERTEX_INPUT_RATE_VERTEX;
+
+  VkVertexInputAttributeDescription attributeDesc[3] = {};
+  attributeDesc[0].location                          = 0;
+  attributeDesc[0].format                            = VK_FORMAT_R32G32_SFLOAT;
+  attributeDesc[0].offset                            = offsetof(ImDrawVert, pos);
+  attributeDesc[1].location                          = 1;
+  attributeDesc[1].format                            = VK_FORMAT_R32G32_SFLOAT;
+  attributeDesc[1].offset                            = offsetof(ImDrawVert, uv);
+  attributeDesc[2].location                          = 2;
+  attributeDesc[2].format                            = VK_FORMAT_R8G8B8A8_UNORM;
+  attributeDesc[2].offset                            = offsetof(ImDrawVert, col);
+
+  VkPipelineVertexInputStateCreateInfo vertexInfo = {};
+  vertexInfo.sType                                = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+  vertexInfo.vertexBindingDescriptionCount        = 1;
+  vertexInfo.pVertexBindingDescriptions           = &bindingDesc;
+  vertexInfo.vertexAttributeDescriptionCount      = 3;
+  vertexInfo.pVertexAttributeDescriptions         = attributeDesc;
+
+  VkPipelineInputAssemblyStateCreateInfo iaInfo = {};
+  iaInfo.sType                                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+  iaInfo.topology                               = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+  VkPipelineViewportStateCreateInfo viewportInfo = {};
+  viewportInfo.sType                             = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+  viewportInfo.viewportCount                     = 1;
+  viewportInfo.scissorCount                      = 1;
+
+  VkPipelineRasterizationStateCreateInfo rasterInfo = {};
+  rasterInfo.sType                                  = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+  rasterInfo.polygonMode                            = VK_POLYGON_MODE_FILL;
+  rasterInfo.cullMode                               = VK_CULL_MODE_NONE;
+  rasterInfo.frontFace                              = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+  rasterInfo.lineWidth                              = 1.0f;
+
+  VkPipelineMultisampleStateCreateInfo msInfo = {};
+  msInfo.sType                                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+  msInfo.rasterizationSamples                 = VK_SAMPLE_COUNT_1_BIT;
+
+  VkPipelineColorBlendAttachmentState colorAttachment = {};
+  colorAttachment.blendEnable                         = VK_TRUE;
+  colorAttachment.srcColorBlendFactor                 = VK_BLEND_FACTOR_SRC_ALPHA;
+  colorAttachment.dstColorBlendFactor                 = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+  colorAttachment.colorBlendOp                        = VK_BLEND_OP_ADD;
+  colorAttachment.srcAlphaBlendFactor                 = VK_BLEND_FACTOR_ONE;
+  colorAttachment.dstAlphaBlendFactor                 = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+  colorAttachment.alphaBlendOp                        = VK_BLEND_OP_ADD;
+  colorAttachment.colorWriteMask =
+      VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+  VkPipelineDepthStencilStateCreateInfo depthInfo = {};
+  depthInfo.sType                                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+
+  VkPipelineColorBlendStateCreateInfo blendInfo = {};
+  blendInfo.sType                               = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+  blendInfo.attachmentCount                     = 1;
+  blendInfo.pAttachments                        = &colorAttachment;
+
+  VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+  VkPipelineDynamicStateCreateInfo dynamicState = {};
+  dynamicState.sType                            = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+  dynamicState.dynamicStateCount                = (uint32_t)IM_ARRAYSIZE(dynamicStates);
+  dynamicState.pDynamicStates                   = dynamicStates;
+
+  VkGraphicsPipelineCreateInfo info = {};
+  info.sType                        = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+  info.stageCount                   = 2;
+  info.pStages                      = stages;
+  info.pVertexInputState            = &vertexInfo;
+  info.pInputAssemblyState          = &iaInfo;
+  info.pViewportState               = &viewportInfo;
+  info.pRasterizationState          = &rasterInfo;
+  info.pMultisampleState            = &msInfo;
+  info.pDepthStencilState           = &depthInfo;
+  info.pColorBlendState             = &blendInfo;
+  info.pDynamicState                = &dynamicState;
+  info.layout                       = m_pipelineLayout;
+  info.renderPass                   = m_initInfo.renderPass;
+  info.subpass                      = m_initInfo.subpass;
+  result = vkCreateGraphicsPipelines(device, m_initInfo.pipelineCache, 1, &info, m_initInfo.allocator, &m_pipeline);
+  CheckVkResult(result);
+
+  vkDestroyShaderModule(device, vertexModule, m_initInfo.allocator);
+  vkDestroyShaderModule(device, fragmentModule, m_initInfo.allocator);
+}
+
+bool RetainedGeometryRenderer::CreateBuffer(
+    Buffer &buffer,
+    VkDeviceSize size,
+    VkBufferUsageFlags usage,
+    VkMemoryPropertyFlags properties
+) {
+  VkResult result;
+  VkDevice device = m_initInfo.device;
+
+  VkBufferCreateInfo bufferInfo = {};
+  bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferInfo.size               = size;
+  bufferInfo.usage              = usage;
+  bufferInfo.sharingMode        = VK_SHARING_MODE_EXCLUSIVE;
+  result                        = vkCreateBuffer(device, &bufferInfo, m_initInfo.allocator, &buffer.handle);
+  CheckVkResult(result);
+  if (result != VK_SUCCESS)
+    return false;
+
+  VkMemoryRequirements requirements;
+  vkGetBufferMemoryRequirements(device, buffer.handle, &requirements);
+  const uint32_t memoryType = FindMemoryType(requirements.memoryTypeBits, properties);
+  if (memoryType == UINT32_MAX) {
+    IM_ASSERT(false && "No suitable memory type");
+    DestroyBuffer(buffer);
+    return false;
+  }
+
+  VkMemoryAllocateInfo allocInfo = {};
+  allocInfo.sType                = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+  allocInfo.allocationSize       = requirements.size;
+  allocInfo.memoryTypeIndex      = memoryType;
+  result                         = vkAllocateMemory(device, &allocInfo, m_initInfo.allocator, &buffer.memory);
+  CheckVkResult(result);
+  if (result == VK_SUCCESS) {
+    result = vkBindBufferMemory(device, buffer.handle, buffer.memory, 0);
+    CheckVkResult(result);
+  }
+  if (result == VK_SUCCESS && (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+    result = vkMapMemory(device, buffer.memory, 0, VK_WHOLE_SIZE, 0, &buffer.mapped);
+    CheckVkResult(result);
+  }
+  if (result != VK_SUCCESS) {
+    DestroyBuffer(buffer);
+    return false;
+  }
+  buffer.size = size;
+  return true;
+}
+
+void RetainedGeometryRenderer::DestroyBuffer(Buffer &buffer) {
+  if (buffer.mapped != nullptr)
+    vkUnmapMemory(m_initInfo.device, buffer.memory);
+  if (buffer.handle != VK_NULL_HANDLE)
+    vkDestroyBuffer(m_initInfo.device, buffer.handle, m_initInfo.allocator);
+  if (buffer.memory != VK_NULL_HANDLE)
+    vkFreeMemory(m_initInfo.device, buffer.memory, m_initInfo.allocator);
+  buffer = {};
+}
+
+uint32_t RetainedGeometryRenderer::FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties) const {
+  VkPhysicalDeviceMemoryProperties memoryProperties;
+  vkGetPhysicalDeviceMemoryProperties(m_initInfo.physicalDevice, &memoryProperties);
+  for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+    if ((typeBits & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+      return i;
+  }
+  return UINT32_MAX; // Unable to find memoryType
+}
+
+void RetainedGeometryRenderer::CheckVkResult(VkResult result) const {
+  if (m_initInfo.checkVkResultFn != nullptr)
+    m_initInfo.checkVkResultFn(result);
+}
+
+void RetainedGeometryRenderer::BeginFrame(uint32_t frameIndex) {
+  if (frameIndex >= m_frames.size())
+    m_frames.resize(frameIndex + 1);
+
+  // Frames are submitted to a single queue, so once the fence of this frame has signaled every earlier submission has
+  // completed as well.
+  FrameData &frame  = m_frames[frameIndex];
+  m_completedSerial = std::max(m_completedSerial, frame.serial);
+  frame.serial      = ++m_serial;
+
+  size_t kept = 0;
+  for (const auto &pending : m_pendingRegions) {
+    if (pending.serial <= m_completedSerial)
+      FreeRegion(pending.region);
+    else
+      m_pendingRegions[kept++] = pending;
+  }
+  m_pendingRegions.resize(kept);
+
+  kept = 0;
+  for (auto &pending : m_pendingBuffers) {
+    if (pending.serial <= m_completedSerial)
+      DestroyBuffer(pending.buffer);
+    else
+      m_pendingBuffers[kept++] = pending;
+  }
+  m_pendingBuffers.resize(kept);
+}
+
+bool RetainedGeometryRenderer::GrowGeometryBuffer(VkDeviceSize requiredSize) {
+  VkDeviceSize size = std::max(m_geometry.size * 2, kInitialGeometryBufferSize);
+  while (size < requiredSize)
+    size *= 2;
+
+  // Frames still in flight may read from the old buffer, the current one has not recorded any draw yet.
+  if (m_geometry.handle != VK_NULL_HANDLE)
+    m_pendingBuffers.push_back({m_serial - 1, m_geometry});
+  m_geometry = {};
+
+  // Regions waiting to be freed belong to the old buffer
+  m_pendingRegions.clear();
+  m_freeRegions.clear();
+  for (auto &it : m_entries)
+    it.second.region = {0, 0};
+
+  if (!CreateBuffer(
+          m_geometry,
+          size,
+          VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+      ))
+    return false;
+  m_freeRegions.assign(1, {0, size});
+  return true;
+}
+
+// Only reached when checkVkResultFn returns on errors, see InitInfo.
+void RetainedGeometryRenderer::DropCache() {
+  for (const auto &it : m_entries)
+    ReleaseRegion(it.second);
+  m_entries.clear();
+  m_uploads.clear();
+  m_stats = {};
+}
+
+bool RetainedGeometryRenderer::AllocateRegion(VkDeviceSize size, Region &region) {
+  // First fit
+  for (auto it = m_freeRegions.begin(); it != m_freeRegions.end(); ++it) {
+    if (it->size < size)
+      continue;
+    region = {it->offset, size};
+    it->offset += size;
+    it->size -= size;
+    if (it->size == 0)
+      m_freeRegions.erase(it);
+    return true;
+  }
+  return false;
+}
+
+void RetainedGeometryRenderer::FreeRegion(Region region) {
+  auto next = std::lower_bound(
+      m_freeRegions.begin(),
+      m_freeRegions.end(),
+      region.offset,
+      [](const Region &r, VkDeviceSize offset) { return r.offset < offset; }
+  );
+  // Merge with the neighbours to keep fragmentation low
+  if (next != m_freeRegions.end() && region.offset + region.size == next->offset) {
+    region.size += next->size;
+    next = m_freeRegions.erase(next);
+  }
+  if (next != m_freeRegions.begin()) {
+    auto prev = std::prev(next);
+    if (prev->offset + prev->size == region.offset) {
+      prev->size += region.size;
+      return;
+    }
+  }
+  m_freeRegions.insert(next, region);
+}
+
+void RetainedGeometryRenderer::ReleaseRegion(const CacheEntry &entry) {
+  if (entry.region.size > 0)
+    m_pendingRegions.push_back({entry.lastUsedSerial, entry.region});
+}
+
+void RetainedGeometryRenderer::SetupRenderState(
+    ImDrawData *drawData,
+    VkCommandBuffer commandBuffer,
+    int fbWidth,
+    int fbHeight
+) {
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
+
+  VkViewport viewport;
+  viewport.x        = 0;
+  viewport.y        = 0;
+  viewport.width    = (float)fbWidth;
+  viewport.height   = (float)fbHeight;
+  viewport.minDepth = 0.0f;
+  viewport.maxDepth = 1.0f;
+  vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+  // Our visible imgui space lies from DisplayPos (top left) to DisplayPos + DisplaySize (bottom right)
+  float scale[2]     = {2.0f / drawData->DisplaySize.x, 2.0f / drawData->DisplaySize.y};
+  float translate[2] = {-1.0f - drawData->DisplayPos.x * scale[0], -1.0f - drawData->DisplayPos.y * scale[1]};
+  vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(scale), scale);
+  vkCmdPushConstants(
+      commandBuffer,
+      m_pipelineLayout,
+      VK_SHADER_STAGE_VERTEX_BIT,
+      sizeof(scale),
+      sizeof(translate),
+      translate
+  );
+}
+
+void RetainedGeometryRenderer::BindGeometry(VkCommandBuffer commandBuffer, const CacheEntry &entry) {
+  const VkDeviceSize vertexOffset = entry.region.offset;
+  vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_geometry.handle, &vertexOffset);
+  vkCmdBindIndexBuffer(
+      commandBuffer,
+      m_geometry.handle,
+      entry.region.offset + entry.indexOffset,
+      sizeof(ImDrawIdx) == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32
+  );
+}
+
+} // namespace KCE
@@ -0,0 +1,133 @@
+#ifndef VulkanImGui_RETAINEDGEOMETRYRENDERER_HPP
+#define VulkanImGui_RETAINEDGEOMETRYRENDERER_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "imgui.h"
+#include <vulkan/vulkan.h>
+
+namespace KCE {
+
+// Drop-in replacement for ImGui_ImplVulkan_RenderDrawData() that keeps the geometry of every ImDrawList in a
+// device-local buffer across frames. Each frame the vertex/index data of a draw list is compared with a CPU copy of its
+// last upload: only the lists whose content changed are copied through a staging buffer, the others are drawn straight
+// from their cached region.
+//
+// Textures are bound through the VkDescriptorSet stored in ImDrawCmd::TextureId, so the Dear ImGui Vulkan backend must
+// be initialised (it owns the font descriptor set). Requires the backend of Dear ImGui 1.86 to 1.89, enforced at
+// compile time, see CreatePipeline().
+class RetainedGeometryRenderer {
+public:
+  struct InitInfo {
+    VkPhysicalDevice physicalDevice         = VK_NULL_HANDLE;
+    VkDevice device                         = VK_NULL_HANDLE;
+    VkRenderPass renderPass                 = VK_NULL_HANDLE;
+    uint32_t subpass                        = 0;
+    VkPipelineCache pipelineCache           = VK_NULL_HANDLE;
+    const VkAllocationCallbacks *allocator  = nullptr;
+    // Called with the result of every Vulkan call, like ImGui_ImplVulkan_InitInfo::CheckVkResultFn. The example's
+    // check_vk_result() exits on errors. If it returns instead (or is null), a failed buffer creation drops the cache
+    // and no geometry is drawn for that frame; the user callbacks still run.
+    void (*checkVkResultFn)(VkResult error) = nullptr;
+  };
+
+  // Geometry traffic of the last rendered frame.
+  struct Stats {
+    size_t uploadedBytes = 0;
+    size_t cachedBytes   = 0;
+    int uploadedLists    = 0;
+    int cachedLists      = 0;
+  };
+
+  explicit RetainedGeometryRenderer(const InitInfo &initInfo);
+  ~RetainedGeometryRenderer();
+  RetainedGeometryRenderer(const RetainedGeometryRenderer &)            = delete;
+  RetainedGeometryRenderer &operator=(const RetainedGeometryRenderer &) = delete;
+
+  // Record the copies of the changed draw lists. Must be called outside the render pass, once the fence of frame
+  // `frameIndex` has been waited on.
+  void UploadDrawData(ImDrawData *drawData, uint32_t frameIndex, VkCommandBuffer commandBuffer);
+  // Record the draw calls. Must be called inside the render pass, after UploadDrawData() with the same draw data.
+  void RenderDrawData(ImDrawData *drawData, VkCommandBuffer commandBuffer);
+  [[nodiscard]] const Stats &GetStats() const { return m_stats; }
+
+private:
+  struct Buffer {
+    VkBuffer handle       = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize size     = 0;
+    void *mapped          = nullptr;
+  };
+
+  struct Region {
+    VkDeviceSize offset;
+    VkDeviceSize size;
+  };
+
+  // Geometry of a draw list, vertices first and then indices, inside the retained buffer. `shadow` keeps the uploaded
+  // bytes (unpadded) for an exact comparison with the next frame.
+  struct CacheEntry {
+    std::vector<char> shadow;
+    size_t vertexBytes       = 0;
+    size_t indexBytes        = 0;
+    Region region            = {0, 0};
+    VkDeviceSize indexOffset = 0;
+    uint64_t lastUsedSerial  = 0;
+  };
+
+  struct FrameData {
+    Buffer staging;
+    uint64_t serial = 0;
+  };
+
+  // Resources still referenced by frames in flight, released once `serial` has completed.
+  struct PendingRegion {
+    uint64_t serial;
+    Region region;
+  };
+  struct PendingBuffer {
+    uint64_t serial;
+    Buffer buffer;
+  };
+
+  void CreatePipeline();
+  bool CreateBuffer(Buffer &buffer, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+  void DestroyBuffer(Buffer &buffer);
+  uint32_t FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties) const;
+  void CheckVkResult(VkResult result) const;
+
+  void BeginFrame(uint32_t frameIndex);
+  bool GrowGeometryBuffer(VkDeviceSize requiredSize);
+  void DropCache();
+  bool AllocateRegion(VkDeviceSize size, Region &region);
+  void FreeRegion(Region region);
+  void ReleaseRegion(const CacheEntry &entry);
+
+  void SetupRenderState(ImDrawData *drawData, VkCommandBuffer commandBuffer, int fbWidth, int fbHeight);
+  void BindGeometry(VkCommandBuffer commandBuffer, const CacheEntry &entry);
+
+  InitInfo m_initInfo;
+  VkSampler m_sampler                         = VK_NULL_HANDLE;
+  VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
+  VkPipelineLayout m_pipelineLayout           = VK_NULL_HANDLE;
+  VkPipeline m_pipeline                       = VK_NULL_HANDLE;
+
+  Buffer m_geometry;
+  std::vector<Region> m_freeRegions; // Sorted by offset, never adjacent
+  std::vector<PendingRegion> m_pendingRegions;
+  std::vector<PendingBuffer> m_pendingBuffers;
+  std::unordered_map<const ImDrawList *, CacheEntry> m_entries;
+  std::vector<std::pair<const ImDrawList *, CacheEntry *>> m_uploads;
+  std::vector<VkBufferCopy> m_copies;
+  std::vector<FrameData> m_frames;
+  uint64_t m_serial          = 0;
+  uint64_t m_completedSerial = 0;
+  Stats m_stats;
+};
+
+} // namespace KCE
+
+#endif // VulkanImGui_RETAINEDGEOMETRYRENDERER_HPP
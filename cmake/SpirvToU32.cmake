@@ -0,0 +1,15 @@
+# Converts a SPIR-V binary to the `{0x...,0x...}` initializer list included by RetainedGeometryRenderer.cpp (same
+# layout as `glslc -mfmt=c`).
+# Usage: cmake -DINPUT=<shader.spv> -DOUTPUT=<shader.u32> -P SpirvToU32.cmake
+file(READ ${INPUT} SPIRV HEX)
+string(LENGTH "${SPIRV}" SPIRV_LENGTH)
+math(EXPR LAST_WORD "${SPIRV_LENGTH} - 8")
+set(WORDS)
+foreach (OFFSET RANGE 0 ${LAST_WORD} 8)
+    # SPIR-V words are little endian
+    string(SUBSTRING "${SPIRV}" ${OFFSET} 8 WORD)
+    string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1" WORD "${WORD}")
+    list(APPEND WORDS ${WORD})
+endforeach ()
+list(JOIN WORDS "," BODY)
+file(WRITE ${OUTPUT} "{${BODY}}\n")
@@ -5,6 +5,7 @@
 #include "imgui.h"
 #include <array>
 #include <cmath>
+#include <string_view>
 
 template <size_t size>
 using plot_array = std::array<float, size>;
@@ -68,9 +69,16 @@ public:
   }
 };
 
-int main() {
+int main(int argc, char **argv) {
   KCE::AppSettings appSettings{};
   appSettings.title = "My Vulkan+ImGui App";
+  // Opt in to the retained geometry renderer and show its per-frame upload stats
+  for (int i = 1; i < argc; ++i) {
+    if (std::string_view(argv[i]) == "--retained-geometry") {
+      appSettings.retainedGeometry = true;
+      appSettings.showRenderStats  = true;
+    }
+  }
   KCE::App<MyApp> app{appSettings};
   app.Run();
   return 0;